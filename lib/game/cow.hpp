@@ -0,0 +1,196 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+
+// Copy-on-write containers. Data lives in flat chunks under a shared directory:
+// a copy shares the directory, a write copies the directory and one chunk.
+// Not safe to share between threads.
+
+// hash map whose chunk count doubles as it grows, so a chunk stays about kChunkLoad entries;
+// a chunk is a flat array of entries sorted by key, Key needs operator<
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class CowMap {
+private:
+    constexpr static size_t kChunkLoad {512};
+    using Entry = std::pair<Key, Value>;
+    using Chunk = std::vector<Entry>;
+    using Directory = std::vector<std::shared_ptr<Chunk>>;
+
+    std::shared_ptr<Directory> directory_ {};
+    size_t chunk_cnt_ {1};
+    size_t size_ {0};
+
+    size_t ChunkIndex(const Key& key) const {
+        // spreads weak hashes, such as the ones of small coordinates, over all chunks
+        uint64_t hash = static_cast<uint64_t>(Hash()(key)) * 0x9E3779B97F4A7C15ull;
+
+        return (hash >> 32) & (chunk_cnt_ - 1);
+    }
+
+    const Chunk* FindChunk(const Key& key) const {
+        if (!directory_) {
+            return nullptr;
+        }
+
+        return (*directory_)[ChunkIndex(key)].get();
+    }
+
+    Chunk& MutableChunk(const Key& key) {
+        if (!directory_) {
+            directory_ = std::make_shared<Directory>(chunk_cnt_);
+        } else if (directory_.use_count() > 1) {
+            directory_ = std::make_shared<Directory>(*directory_);
+        }
+        std::shared_ptr<Chunk>& chunk = (*directory_)[ChunkIndex(key)];
+        if (!chunk) {
+            chunk = std::make_shared<Chunk>();
+        } else if (chunk.use_count() > 1) {
+            chunk = std::make_shared<Chunk>(*chunk);
+        }
+
+        return *chunk;
+    }
+
+    template <typename Entries>
+    static auto LowerBound(Entries& chunk, const Key& key) {
+        return std::lower_bound(chunk.begin(), chunk.end(), key, [](const Entry& entry, const Key& key) {
+            return entry.first < key;
+        });
+    }
+
+    void Grow() {
+        CowMap grown;
+        grown.chunk_cnt_ = chunk_cnt_ * 2;
+        AnyOf([&grown](const Key& key, const Value& value) {
+            grown[key] = value;
+            return false;
+        });
+        *this = std::move(grown);
+    }
+public:
+    size_t Size() const {
+        return size_;
+    }
+
+    const Value* Find(const Key& key) const {
+        const Chunk* chunk = FindChunk(key);
+        if (!chunk) {
+            return nullptr;
+        }
+        auto iterator = LowerBound(*chunk, key);
+
+        return iterator == chunk->end() || key < iterator->first ? nullptr : &iterator->second;
+    }
+
+    bool Contains(const Key& key) const {
+        return Find(key) != nullptr;
+    }
+
+    Value& operator[](const Key& key) {
+        Chunk& chunk = MutableChunk(key);
+        auto iterator = LowerBound(chunk, key);
+        if (iterator != chunk.end() && !(key < iterator->first)) {
+            return iterator->second;
+        }
+        iterator = chunk.emplace(iterator, key, Value{});
+        if (++size_ <= chunk_cnt_ * kChunkLoad) {
+            return iterator->second;
+        }
+        Grow();
+
+        return (*this)[key];
+    }
+
+    bool Erase(const Key& key) {
+        if (!Contains(key)) {
+            return false;
+        }
+        Chunk& chunk = MutableChunk(key);
+        chunk.erase(LowerBound(chunk, key));
+        --size_;
+
+        return true;
+    }
+
+    void Clear() {
+        directory_.reset();
+        chunk_cnt_ = 1;
+        size_ = 0;
+    }
+
+    // calls the function for entries until it returns true
+    template <typename Function>
+    bool AnyOf(Function function) const {
+        if (!directory_) {
+            return false;
+        }
+        for (const std::shared_ptr<Chunk>& chunk: *directory_) {
+            if (!chunk) {
+                continue;
+            }
+            for (const auto& [key, value]: *chunk) {
+                if (function(key, value)) {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+};
+
+// vector split into fixed-size chunks, the last one grows like a plain vector
+template <typename T>
+class CowVector {
+private:
+    constexpr static size_t kChunkSize {256};
+    using Chunk = std::vector<T>;
+    using Directory = std::vector<std::shared_ptr<Chunk>>;
+
+    std::shared_ptr<Directory> directory_ {};
+    size_t size_ {0};
+
+    Chunk& MutableChunk(size_t i) {
+        if (!directory_) {
+            directory_ = std::make_shared<Directory>();
+        } else if (directory_.use_count() > 1) {
+            directory_ = std::make_shared<Directory>(*directory_);
+        }
+        size_t chunk_index = i / kChunkSize;
+        if (chunk_index >= directory_->size()) {
+            directory_->push_back(std::make_shared<Chunk>());
+        }
+        std::shared_ptr<Chunk>& chunk = (*directory_)[chunk_index];
+        if (chunk.use_count() > 1) {
+            chunk = std::make_shared<Chunk>(*chunk);
+        }
+
+        return *chunk;
+    }
+public:
+    size_t Size() const {
+        return size_;
+    }
+
+    bool IsEmpty() const {
+        return size_ == 0;
+    }
+
+    const T& operator[](size_t i) const {
+        return (*(*directory_)[i / kChunkSize])[i % kChunkSize];
+    }
+
+    T& Mutable(size_t i) {
+        return MutableChunk(i)[i % kChunkSize];
+    }
+
+    void PushBack(const T& value) {
+        MutableChunk(size_).push_back(value);
+        ++size_;
+    }
+};
@@ -1,6 +1,9 @@
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
 #include "game.hpp"
 
@@ -14,29 +17,82 @@ bool Player::CheckMaster() {
     return (type_ == PlayerType::kMaster);
 }
 
-void Player::AddShip(Ship* ship) {
-    for (size_t i = 0; i < ship->array.size(); ++i) {
-        ships_[ship->array[i]] = ship;
+// largest absolute coordinate among the cells of the ship
+uint64_t Player::GetExtentUtil(const Ship& ship) {
+    auto magnitude = [](int64_t value) {
+        return value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    };
+    Coordinate tail = ship.GetCell(ship.size - 1);
+
+    return std::max({magnitude(ship.head.x), magnitude(ship.head.y), magnitude(tail.x), magnitude(tail.y)});
+}
+
+// picks the narrowest board that holds the side and every ship already placed
+void Player::ReshapeUtil(uint64_t side) {
+    std::vector<Ship> ships = std::visit([](const auto& board) {
+        return board.GetShips();
+    }, board_);
+    for (const Ship& ship: ships) {
+        side = std::max(side, GetExtentUtil(ship));
+    }
+    if (side <= Board<int16_t>::kMaxSide) {
+        board_.emplace<Board<int16_t>>();
+    } else if (side <= Board<int32_t>::kMaxSide) {
+        board_.emplace<Board<int32_t>>();
+    } else {
+        board_.emplace<Board<int64_t>>();
+    }
+    for (const Ship& ship: ships) {
+        std::visit([&ship](auto& board) {
+            board.AddShip(ship);
+        }, board_);
     }
 }
 
-bool Player::CheckCoord(const Coordinate& coord, const Game& game) {
-    return ships_.contains(coord);
+void Player::Reshape(uint64_t width, uint64_t height) {
+    ReshapeUtil(std::max(width, height));
 }
 
-Ship* Player::GetShip(const Coordinate& coord) {
-    if (ships_.contains(coord)) {
-        return ships_[coord];
+bool Player::AddShip(const Ship& ship) {
+    if (ship.size == 0 || ship.size > Ship::kMaxSize) {
+        return false;
+    }
+    // a ship out of the board range, such as a loaded one beyond the field, widens the board
+    uint64_t extent = GetExtentUtil(ship);
+    uint64_t max_side = std::visit([](const auto& board) {
+        return board.kMaxSide;
+    }, board_);
+    if (extent > max_side) {
+        ReshapeUtil(extent);
     }
 
-    return nullptr;
+    return std::visit([&ship](auto& board) {
+        return board.AddShip(ship);
+    }, board_);
 }
 
-void Player::DeleteCoord(const Coordinate& coord) {
-    auto iterator = ships_.find(coord);
-    if (iterator != ships_.end()) {
-        ships_[coord] = nullptr;
-    }
+bool Player::CheckCoord(const Coordinate& coord) const {
+    return std::visit([&coord](const auto& board) {
+        return board.CheckCoord(coord);
+    }, board_);
+}
+
+bool Player::CheckShip(const Coordinate& coord) const {
+    return std::visit([&coord](const auto& board) {
+        return board.CheckShip(coord);
+    }, board_);
+}
+
+bool Player::IsEmpty() const {
+    return std::visit([](const auto& board) {
+        return board.IsEmpty();
+    }, board_);
+}
+
+ShotResult Player::TakeShot(const Coordinate& coord) {
+    return std::visit([&coord](auto& board) {
+        return board.TakeShot(coord);
+    }, board_);
 }
 
 void Player::SetShotResult(const ShotResult& result) {
@@ -45,23 +101,173 @@ void Player::SetShotResult(const ShotResult& result) {
 
 void Player::DumpShips(std::ofstream& file) {
     if (file.is_open()) {
-        Ship* last = nullptr;
-        for (auto iterator: ships_) {
-            Ship* ship = iterator.second;
-            if (ship && ship != last) {
-                file << ship->array.size() << " ";
-                if (ship->is_horizontal) {
-                    file << 'h' << " ";
-                } else {
-                    file << 'v' << " ";
+        std::vector<Ship> ships = std::visit([](const auto& board) {
+            return board.GetShips();
+        }, board_);
+        for (const Ship& ship: ships) {
+            if (!ship.alive_mask) {
+                continue;
+            }
+            file << static_cast<uint64_t>(ship.size) << " ";
+            if (ship.is_horizontal) {
+                file << 'h' << " ";
+            } else {
+                file << 'v' << " ";
+            }
+            file << ship.head.x << " " << ship.head.y;
+            // a wounded ship also gets the state of each deck from its head, 1 for alive
+            if (ship.alive_mask != (1u << ship.size) - 1) {
+                file << " ";
+                for (size_t i = 0; i < ship.size; ++i) {
+                    file << ((ship.alive_mask >> i) & 1);
+                }
+            }
+            file << '\n';
+        }
+    }
+}
+
+// class EnemyField methods
+void EnemyField::Reset(uint64_t width, uint64_t height) {
+    known_.Clear();
+    hits_.Clear();
+    width_ = width;
+    height_ = height;
+    for (size_t i = 0; i < kCntSize; ++i) {
+        sunk_cnt_[i] = 0;
+    }
+}
+
+bool EnemyField::Contains(const Coordinate& coord) const {
+    if (coord.x < 0 || coord.y < 0) {
+        return false;
+    }
+
+    return static_cast<uint64_t>(coord.x) < width_ && static_cast<uint64_t>(coord.y) < height_;
+}
+
+bool EnemyField::IsKnown(const Coordinate& coord) const {
+    const std::shared_ptr<Row>* row = known_.Find(coord.y);
+    if (!row) {
+        return false;
+    }
+    auto interval = (*row)->upper_bound(coord.x);
+    if (interval == (*row)->begin()) {
+        return false;
+    }
+    --interval;
+
+    return interval->second >= coord.x;
+}
+
+bool EnemyField::IsHit(const Coordinate& coord) const {
+    return hits_.Contains(coord);
+}
+
+int64_t EnemyField::NextUnknownInRow(int64_t y, int64_t x) const {
+    const std::shared_ptr<Row>* row = known_.Find(y);
+    if (!row) {
+        return x;
+    }
+    auto interval = (*row)->upper_bound(x);
+    if (interval == (*row)->begin()) {
+        return x;
+    }
+    --interval;
+    if (interval->second >= x) {
+        // intervals are merged, so the cell right after one is always unknown
+        return interval->second + 1;
+    }
+
+    return x;
+}
+
+void EnemyField::MarkKnown(const Coordinate& coord) {
+    if (!Contains(coord) || IsKnown(coord)) {
+        return;
+    }
+    std::shared_ptr<Row>& shared_row = known_[coord.y];
+    if (!shared_row) {
+        shared_row = std::make_shared<Row>();
+    } else if (shared_row.use_count() > 1) {
+        shared_row = std::make_shared<Row>(*shared_row);
+    }
+    Row& row = *shared_row;
+    int64_t last = coord.x;
+    auto next = row.find(coord.x + 1);
+    if (next != row.end()) {
+        last = next->second;
+        row.erase(next);
+    }
+    auto prev = row.lower_bound(coord.x);
+    if (prev != row.begin()) {
+        --prev;
+        if (prev->second == coord.x - 1) {
+            prev->second = last;
+
+            return;
+        }
+    }
+    row[coord.x] = last;
+}
+
+void EnemyField::MarkHalo(const Coordinate& coord) {
+    for (int64_t dy = -1; dy <= 1; ++dy) {
+        for (int64_t dx = -1; dx <= 1; ++dx) {
+            MarkKnown(Coordinate(coord.x + dx, coord.y + dy));
+        }
+    }
+}
+
+void EnemyField::MarkShot(const Coordinate& coord, const ShotResult& result) {
+    if (!Contains(coord)) {
+        return;
+    }
+    MarkKnown(coord);
+    if (result == ShotResult::kHit) {
+        // ships never touch by corners, so diagonal cells of a hit are empty
+        hits_[coord] = true;
+        MarkKnown(Coordinate(coord.x + 1, coord.y + 1));
+        MarkKnown(Coordinate(coord.x - 1, coord.y + 1));
+        MarkKnown(Coordinate(coord.x + 1, coord.y - 1));
+        MarkKnown(Coordinate(coord.x - 1, coord.y - 1));
+    } else if (result == ShotResult::kKill) {
+        std::vector<Coordinate> ship {coord};
+        hits_.Erase(coord);
+        for (size_t i = 0; i < ship.size(); ++i) {
+            Coordinate neighbours[] = {
+                Coordinate(ship[i].x + 1, ship[i].y),
+                Coordinate(ship[i].x - 1, ship[i].y),
+                Coordinate(ship[i].x, ship[i].y + 1),
+                Coordinate(ship[i].x, ship[i].y - 1),
+            };
+            for (const Coordinate& neighbour: neighbours) {
+                if (hits_.Erase(neighbour)) {
+                    ship.push_back(neighbour);
                 }
-                file << ship->head.x<< " " << ship->head.y << '\n';
-                last = ship;
             }
         }
+        for (const Coordinate& cell: ship) {
+            MarkHalo(cell);
+        }
+        if (ship.size() <= kCntSize) {
+            ++sunk_cnt_[ship.size() - 1];
+        }
     }
 }
 
+const CowMap<Coordinate, bool, HashFunction>& EnemyField::GetHits() const {
+    return hits_;
+}
+
+uint64_t EnemyField::GetSunkCount(size_t n) const {
+    if (n >= 1 && n <= kCntSize) {
+        return sunk_cnt_[n - 1];
+    }
+
+    return 0;
+}
+
 // class Game methods
 const uint64_t& Game::GetCountUtil(size_t n) const {
     if (n >= 1 && n <= 4) {
@@ -83,12 +289,14 @@ bool Game::SetCountUtil(size_t n, uint64_t value) {
 
 bool Game::SetHeight(uint64_t height) {
     field_.height = height;
+    SchedulePlacementUtil();
 
     return true;
 }
 
 bool Game::SetWidth(uint64_t width) {
     field_.width = width;
+    SchedulePlacementUtil();
 
     return true;
 }
@@ -115,8 +323,29 @@ bool Game::SetCount(size_t n, uint64_t value) {
     if (!CheckCapacityUtil(n, value, field_.height, field_.width)) {
         return false;
     }
-    
-    return SetCountUtil(n, value);
+    if (!SetCountUtil(n, value)) {
+        return false;
+    }
+    SchedulePlacementUtil();
+
+    return true;
+}
+
+bool Game::SetTimeLimit(uint64_t time_limit_ms) {
+    if (time_limit_ms > kMaxTimeLimitMs) {
+        return false;
+    }
+    time_limit_ms_ = time_limit_ms;
+
+    return true;
+}
+
+const uint64_t& Game::GetTimeLimit() const {
+    return time_limit_ms_;
+}
+
+const uint64_t& Game::GetMoveTime() const {
+    return last_move_time_us_;
 }
 
 const uint64_t& Game::GetHeight() const {
@@ -144,11 +373,19 @@ bool Game::IsFinished() {
 }
 
 void Game::Create(const PlayerType& type) {
+    CreateUtil(type);
+    SchedulePlacementUtil();
+}
+
+void Game::CreateUtil(const PlayerType& type) {
+    CancelPlacementUtil();
     delete player_;
     player_ = new Player;
     if (type == PlayerType::kMaster) {
         player_->SetMaster();
+        is_placement_deferred_ = true;
         SetDefaultParametersUtil();
+        is_placement_deferred_ = false;
     }
 }
 
@@ -161,6 +398,41 @@ void Game::SetDefaultParametersUtil() {
     SetCount(4, kFourDeckDefaultValue);
 }
 
+bool Game::CheckConfigUtil() const {
+    if (field_.width == 0 || field_.height == 0) {
+        return false;
+    }
+
+    return GetCount(1) + GetCount(2) + GetCount(3) + GetCount(4) > 0;
+}
+
+void Game::CancelPlacementUtil() {
+    if (placement_thread_.joinable()) {
+        placement_cancelled_ = true;
+        placement_thread_.join();
+        placement_cancelled_ = false;
+    }
+    delete placed_player_;
+    placed_player_ = nullptr;
+}
+
+void Game::SchedulePlacementUtil() {
+    if (is_placement_deferred_) {
+        return;
+    }
+    CancelPlacementUtil();
+    // loaded ships are placed around, so only an empty player can be prepared in advance
+    if (!player_ || !player_->IsEmpty() || !CheckConfigUtil()) {
+        return;
+    }
+    placed_field_ = field_;
+    placed_player_ = new Player;
+    placed_player_->Reshape(placed_field_.width, placed_field_.height);
+    placement_thread_ = std::thread([this]() {
+        Strategy::PlaceShips(placed_field_, placed_player_, placement_cancelled_);
+    });
+}
+
 void Game::SetStrategy(const StrategyType& strategy_type) {
     delete strategy_;
     if (strategy_type == StrategyType::kCustom) {
@@ -178,7 +450,21 @@ void Game::Start() {
     if (!strategy_) {
         SetStrategy(StrategyType::kCustom);
     }
-    strategy_->PlaceShips(*this);
+    if (placement_thread_.joinable()) {
+        placement_thread_.join();
+        if (player_->CheckMaster()) {
+            placed_player_->SetMaster();
+        }
+        delete player_;
+        player_ = placed_player_;
+        placed_player_ = nullptr;
+    } else {
+        const std::atomic<bool> kNotCancelled {false};
+        player_->Reshape(field_.width, field_.height);
+        Strategy::PlaceShips(field_, player_, kNotCancelled);
+    }
+    enemy_field_.Reset(field_.width, field_.height);
+    strategy_->Reset();
     field_.my_ships_alive = GetCount(1) + GetCount(2) + GetCount(3) + GetCount(4);
     field_.enemy_ships_alive = field_.my_ships_alive;
 }
@@ -190,15 +476,12 @@ void Game::Stop() {
 void Game::PrintField() const {
     for (int64_t y = 0; y < field_.height; ++y) {
         for (int64_t x = 0; x < field_.width; ++x) {
-            if (!player_->CheckCoord(Coordinate(x, y), *this) ) {
+            if (!player_->CheckCoord(Coordinate(x, y)) ) {
                 std::cout << 0 << " ";
+            } else if (!player_->CheckShip(Coordinate(x, y))) {
+                std::cout << "*" << " ";
             } else {
-                Ship* ship = player_->GetShip(Coordinate(x, y));
-                if (!ship) {
-                    std::cout << "*" << " ";
-                } else {
-                    std::cout << 1 << " ";
-                }
+                std::cout << 1 << " ";
             }
         }
         std::cout << '\n';
@@ -210,55 +493,86 @@ std::string Game::CheckShot(const Coordinate& coord) {
     if (!player_) {
         return "miss";
     }
-    Ship* ship = player_->GetShip(coord);
-    if (!ship) {
-        return "miss";
-    }
-
-    for (size_t i = 0; i < ship->array.size(); ++i) {
-        if (ship->array[i] == coord) {
-            player_->DeleteCoord(coord);
-            std::swap(ship->array[i], ship->array[ship->array.size() - 1]);
-            ship->array.pop_back();
-            if (ship->array.empty()) {
-                --field_.my_ships_alive;
-                if (field_.my_ships_alive <= 0) {
-                    current_game_status_ = GameStatus::kLose;
-                }
-                return "kill";
-            }
-
-            return "hit";
+    ShotResult result = player_->TakeShot(coord);
+    if (result == ShotResult::kKill) {
+        --field_.my_ships_alive;
+        if (field_.my_ships_alive <= 0) {
+            current_game_status_ = GameStatus::kLose;
         }
+        return "kill";
+    } else if (result == ShotResult::kHit) {
+        return "hit";
     }
 
     return "miss";
 }
 
-const Coordinate& Game::SetShot() {
-    return strategy_->ShotUtil(*this);
+bool Game::SetShot(Coordinate* shot) {
+    if (!strategy_) {
+        return false;
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Coordinate coord;
+    if (time_limit_ms_ == 0) {
+        coord = strategy_->ShotUtil(*this);
+    } else {
+        // the margin covers the work done after the last deadline check
+        std::chrono::microseconds budget = std::chrono::milliseconds(time_limit_ms_);
+        std::chrono::steady_clock::time_point deadline = start + budget - budget / kDeadlineMarginShare;
+        coord = strategy_->ShotUtilUntil(*this, deadline);
+    }
+    last_move_time_us_ = std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - start
+                            ).count();
+    // a strategy out of unknown cells must not re-fire at a known one
+    if (!enemy_field_.Contains(coord) || enemy_field_.IsKnown(coord)) {
+        return false;
+    }
+    last_shot_ = coord;
+    *shot = coord;
+
+    return true;
 }
 
 ShotResult Game::SetShotResult(const std::string& result) {
+    ShotResult shot_result = ShotResult::kUndefined;
     if (result == "miss") {
-        return ShotResult::kMiss;
+        shot_result = ShotResult::kMiss;
     } else if (result == "hit") {
-        return ShotResult::kHit;
+        shot_result = ShotResult::kHit;
     } else if (result == "kill") {
+        shot_result = ShotResult::kKill;
+    }
+    ApplyShotResult(last_shot_, shot_result);
+
+    return shot_result;
+}
+
+// records the result of a shot at any cell, lookahead on a fork uses it for hypothetical shots
+void Game::ApplyShotResult(const Coordinate& coord, const ShotResult& result) {
+    if (result == ShotResult::kUndefined) {
+        return;
+    }
+    enemy_field_.MarkShot(coord, result);
+    if (result == ShotResult::kKill) {
         --field_.enemy_ships_alive;
         if (field_.enemy_ships_alive <= 0) {
             current_game_status_ = GameStatus::kWin;
         }
-        return ShotResult::kKill;
     }
+}
 
-    return ShotResult::kUndefined;
+const EnemyField& Game::GetEnemyField() const {
+    return enemy_field_;
 }
 
 void Game::Load(const std::string& path) {
     if (!player_) {
-        Create(PlayerType::kSlave);
+        CreateUtil(PlayerType::kSlave);
     }
+    // loaded ships disable pre-placement, so nothing is scheduled for the new size
+    CancelPlacementUtil();
+    is_placement_deferred_ = true;
     std::ifstream file(path);
     uint64_t field_width{};
     uint64_t field_height{};
@@ -267,34 +581,34 @@ void Game::Load(const std::string& path) {
         file >> field_width >> field_height;
         SetWidth(field_width);
         SetHeight(field_height);
+        player_->Reshape(field_width, field_height);
     }
 
-    while (!file.eof()) {
-        size_t ship_size;
-        char direction;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream ship_line(line);
+        size_t ship_size {0};
+        char direction {};
         uint64_t x_coord;
         uint64_t y_coord;
-        file >> ship_size >> direction >> x_coord >> y_coord;
-        Ship* ship = new Ship;
-        ship->array.push_back(Coordinate(x_coord, y_coord));
-        switch (direction) {
-            case 'h':
-                for (uint64_t i = 1; i < ship_size; ++i) {
-                    ship->array.push_back(Coordinate(x_coord + i, y_coord));
-                }
-                ship->is_horizontal = true;
-                ship->head = Coordinate(x_coord, y_coord);
-                player_->AddShip(ship);
-                break;
-            case 'v':
-                for (uint64_t i = 1; i < ship_size; ++i) {
-                    ship->array.push_back(Coordinate(x_coord, y_coord + i));
-                }
-                ship->head = Coordinate(x_coord, y_coord);
-                player_->AddShip(ship);
-                break;
+        std::string decks;
+        if (!(ship_line >> ship_size >> direction >> x_coord >> y_coord)) {
+            continue;
+        }
+        if (direction != 'h' && direction != 'v') {
+            continue;
+        }
+        Ship ship(Coordinate(x_coord, y_coord), ship_size, direction == 'h');
+        if (ship_line >> decks && decks.size() == ship.size
+            && decks.find_first_not_of("01") == std::string::npos) {
+            ship.alive_mask = 0;
+            for (size_t i = 0; i < decks.size(); ++i) {
+                ship.alive_mask |= (decks[i] == '1') << i;
+            }
         }
+        player_->AddShip(ship);
     }
+    is_placement_deferred_ = false;
 
     file.close();
 }
@@ -311,15 +625,35 @@ void Game::Dump(const std::string& path) {
     file.close();
 }
 
+std::unique_ptr<Game> Game::Fork() const {
+    // a pending background placement is not forked, the fork places synchronously on start
+    std::unique_ptr<Game> fork = std::make_unique<Game>();
+    fork->field_ = field_;
+    if (player_) {
+        fork->player_ = new Player(*player_);
+    }
+    if (strategy_) {
+        fork->strategy_ = strategy_->Clone();
+    }
+    fork->enemy_field_ = enemy_field_;
+    fork->last_shot_ = last_shot_;
+    fork->time_limit_ms_ = time_limit_ms_;
+    fork->last_move_time_us_ = last_move_time_us_;
+    fork->current_game_status_ = current_game_status_;
+    fork->current_game_process_ = current_game_process_;
+
+    return fork;
+}
+
 // Strategy methods
-bool Strategy::ValidateCell(const Coordinate& coord, const Game& game) {
-    if (coord.x >= game.field_.width || coord.y >= game.field_.height) {
+bool Strategy::ValidateCell(const Coordinate& coord, const Field& field, const Player* player) {
+    if (coord.x >= field.width || coord.y >= field.height) {
         return false;
     }
     if (coord.x < 0 || coord.y < 0) {
         return false;
     }
-    if (!game.player_) {
+    if (!player) {
         return false;
     }
 
@@ -333,52 +667,44 @@ bool Strategy::ValidateCell(const Coordinate& coord, const Game& game) {
     Coordinate cell8(coord.x - 1, coord.y - 1);
 
     bool is_valid = 
-                    !game.player_->CheckCoord(cell1, game) 
-                    && !game.player_->CheckCoord(cell2, game)
-                    && !game.player_->CheckCoord(cell3, game)
-                    && !game.player_->CheckCoord(cell4, game)
-                    && !game.player_->CheckCoord(cell5, game)
-                    && !game.player_->CheckCoord(cell6, game)
-                    && !game.player_->CheckCoord(cell7, game)
-                    && !game.player_->CheckCoord(cell8, game);
+                    !player->CheckCoord(cell1) 
+                    && !player->CheckCoord(cell2)
+                    && !player->CheckCoord(cell3)
+                    && !player->CheckCoord(cell4)
+                    && !player->CheckCoord(cell5)
+                    && !player->CheckCoord(cell6)
+                    && !player->CheckCoord(cell7)
+                    && !player->CheckCoord(cell8);
 
     return is_valid;
 }
 
-bool Strategy::TryPlaceShip(Ship* ship, const Game& game) {
-    for (size_t i = 0; i < ship->array.size(); ++i) {
-        if (!ValidateCell(ship->array[i], game)) {
-            delete ship;
+bool Strategy::TryPlaceShip(const Ship& ship, const Field& field, Player* player) {
+    for (size_t i = 0; i < ship.size; ++i) {
+        if (!ValidateCell(ship.GetCell(i), field, player)) {
             return false;
         }
     }
-    game.player_->AddShip(ship);
 
-    return true;
+    return player->AddShip(ship);
 }
 
-void Strategy::PlaceOneSizeShips(size_t size, int64_t n, const Game& game) {
+void Strategy::PlaceOneSizeShips(size_t size, int64_t n, const Field& field, Player* player
+                                , const std::atomic<bool>& cancelled) {
     while (n > 0) {
-        for (int64_t x = 0; x < game.GetWidth(); ++x) {
-            for (int64_t y = 0; y < game.GetHeight(); ++y) {
+        for (int64_t x = 0; x < field.width; ++x) {
+            for (int64_t y = 0; y < field.height; ++y) {
+                if (cancelled) {
+                    return;
+                }
                 Coordinate coord(x, y);
-                if (ValidateCell(coord, game)) {
-                    Ship* ship1 = new Ship;
-                    Ship* ship2 = new Ship;
-                    ship1->array.push_back(coord);
-                    ship1->head = coord;
-                    ship2->array.push_back(coord);
-                    ship2->head = coord;
-
-                    for (int64_t i = 1; i <= size; ++i) {
-                        ship1->array.push_back(Coordinate(x + i, y));
-                        ship2->array.push_back(Coordinate(x, y + i));
-                    }
-                    ship1->is_horizontal = true;
+                if (ValidateCell(coord, field, player)) {
+                    Ship horizontal_ship(coord, size + 1, true);
+                    Ship vertical_ship(coord, size + 1, false);
 
-                    if (TryPlaceShip(ship1, game)) {
+                    if (TryPlaceShip(horizontal_ship, field, player)) {
                         --n;
-                    } else if (TryPlaceShip(ship2, game)) {
+                    } else if (TryPlaceShip(vertical_ship, field, player)) {
                         --n;
                     }
                     if (n <= 0) {
@@ -390,45 +716,160 @@ void Strategy::PlaceOneSizeShips(size_t size, int64_t n, const Game& game) {
     }
 }
 
-void Strategy::PlaceShips(const Game& game) {
+void Strategy::PlaceShips(const Field& field, Player* player, const std::atomic<bool>& cancelled) {
     const int8_t kFourIndex = 3;
     const int8_t kThreeIndex = 2;
     const int8_t kTwoIndex = 1;
     const int8_t kOneIndex = 0;
-    int64_t four_cnt = game.field_.ships_cnt_[kFourIndex];
-    int64_t three_cnt = game.field_.ships_cnt_[kThreeIndex];
-    int64_t two_cnt = game.field_.ships_cnt_[kTwoIndex];
-    int64_t one_cnt = game.field_.ships_cnt_[kOneIndex];
-    PlaceOneSizeShips(kFourIndex, four_cnt, game);
-    PlaceOneSizeShips(kThreeIndex, three_cnt, game);
-    PlaceOneSizeShips(kTwoIndex, two_cnt, game);
-    PlaceOneSizeShips(kOneIndex, one_cnt, game);
+    int64_t four_cnt = field.ships_cnt_[kFourIndex];
+    int64_t three_cnt = field.ships_cnt_[kThreeIndex];
+    int64_t two_cnt = field.ships_cnt_[kTwoIndex];
+    int64_t one_cnt = field.ships_cnt_[kOneIndex];
+    PlaceOneSizeShips(kFourIndex, four_cnt, field, player, cancelled);
+    PlaceOneSizeShips(kThreeIndex, three_cnt, field, player, cancelled);
+    PlaceOneSizeShips(kTwoIndex, two_cnt, field, player, cancelled);
+    PlaceOneSizeShips(kOneIndex, one_cnt, field, player, cancelled);
+}
+
+// moves next_shot_coord_ to the first unknown cell in row order
+bool Strategy::FindUnknownCell(const Game& game) {
+    const EnemyField& enemy = game.GetEnemyField();
+    // known cells only grow, so rows above scan_row_ stay fully known
+    for (; scan_row_ < game.GetHeight(); ++scan_row_) {
+        int64_t x = enemy.NextUnknownInRow(scan_row_, 0);
+        if (x < game.GetWidth()) {
+            next_shot_coord_ = Coordinate(x, scan_row_);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Strategy::Reset() {
+    next_shot_coord_ = Coordinate(0, 0);
+    scan_row_ = 0;
+}
+
+const Coordinate& Strategy::ShotUtilUntil(const Game& game
+                                        , const std::chrono::steady_clock::time_point& deadline) {
+    return ShotUtil(game);
+}
+
+Strategy* OrderedStrategy::Clone() const {
+    return new OrderedStrategy(*this);
+}
+
+Strategy* CustomStrategy::Clone() const {
+    return new CustomStrategy(*this);
 }
 
 const Coordinate& OrderedStrategy::ShotUtil(const Game& game) {
-    if (next_shot_coord_.x + 1 <= game.GetWidth()) {
-        ++next_shot_coord_.x;
-    } else {
-        ++next_shot_coord_.y;
-        next_shot_coord_.x = 0;
-    }
-    if (next_shot_coord_.y > game.GetHeight()) {
-        next_shot_coord_.y = 0;
-    }
+    FindUnknownCell(game);
 
     return next_shot_coord_;
 }
 
+bool CustomStrategy::TryFinishShip(const Game& game) {
+    const EnemyField& enemy = game.GetEnemyField();
+    const Coordinate kDirections[] = {
+        Coordinate(1, 0),
+        Coordinate(-1, 0),
+        Coordinate(0, 1),
+        Coordinate(0, -1),
+    };
+    return enemy.GetHits().AnyOf([&](const Coordinate& hit, bool) {
+        for (const Coordinate& direction: kDirections) {
+            Coordinate coord(hit.x + direction.x, hit.y + direction.y);
+            while (enemy.IsHit(coord)) {
+                coord = Coordinate(coord.x + direction.x, coord.y + direction.y);
+            }
+            if (enemy.Contains(coord) && !enemy.IsKnown(coord)) {
+                next_shot_coord_ = coord;
+
+                return true;
+            }
+        }
+
+        return false;
+    });
+}
+
 const Coordinate& CustomStrategy::ShotUtil(const Game& game) {
-    if (next_shot_coord_.y + 1 <= game.GetHeight()) {
-        ++next_shot_coord_.y;
-    } else {
-        ++next_shot_coord_.x;
-        next_shot_coord_.y = 0;
+    if (TryFinishShip(game)) {
+        return next_shot_coord_;
     }
-    if (next_shot_coord_.x > game.GetWidth()) {
-        next_shot_coord_.x = 0;
+    FindUnknownCell(game);
+
+    return next_shot_coord_;
+}
+
+
+// number of ways the remaining enemy fleet can cover the cell
+uint64_t CustomStrategy::ScoreCell(const Coordinate& coord, const Game& game) {
+    const EnemyField& enemy = game.GetEnemyField();
+    uint64_t score = 0;
+    for (int64_t size = 1; size <= Field::kCntSize; ++size) {
+        uint64_t alive = game.GetCount(size) - std::min(game.GetCount(size), enemy.GetSunkCount(size));
+        if (alive == 0) {
+            continue;
+        }
+        uint64_t placements = 0;
+        for (int64_t shift = 0; shift < size; ++shift) {
+            bool horizontal_fits = true;
+            bool vertical_fits = true;
+            for (int64_t i = 0; i < size; ++i) {
+                Coordinate horizontal(coord.x - shift + i, coord.y);
+                Coordinate vertical(coord.x, coord.y - shift + i);
+                horizontal_fits = horizontal_fits && enemy.Contains(horizontal) && !enemy.IsKnown(horizontal);
+                vertical_fits = vertical_fits && enemy.Contains(vertical) && !enemy.IsKnown(vertical);
+            }
+            placements += horizontal_fits;
+            // a one-deck ship has a single placement
+            placements += vertical_fits && size > 1;
+        }
+        score += placements * alive;
+    }
+
+    return score;
+}
+
+const Coordinate& CustomStrategy::ShotUtilUntil(const Game& game
+                                            , const std::chrono::steady_clock::time_point& deadline) {
+    if (TryFinishShip(game) || !FindUnknownCell(game)) {
+        return next_shot_coord_;
+    }
+    const EnemyField& enemy = game.GetEnemyField();
+    Coordinate best = next_shot_coord_;
+    uint64_t best_score = ScoreCell(best, game);
+    // the R2 sequence spreads samples over the whole board, so a short budget
+    // still scores cells far from the top rows
+    const double kStepX {0.7548776662466927};
+    const double kStepY {0.5698402909980532};
+    uint64_t width = game.GetWidth();
+    uint64_t height = game.GetHeight();
+    uint64_t sample_cnt = width > UINT64_MAX / height ? UINT64_MAX : width * height;
+    double fraction_x = 0.5;
+    double fraction_y = 0.5;
+    // one cell costs dozens of lookups, so the clock is cheap next to it
+    for (uint64_t i = 0; i < sample_cnt && std::chrono::steady_clock::now() < deadline; ++i) {
+        fraction_x += kStepX;
+        fraction_x -= std::floor(fraction_x);
+        fraction_y += kStepY;
+        fraction_y -= std::floor(fraction_y);
+        Coordinate coord(static_cast<int64_t>(fraction_x * width), static_cast<int64_t>(fraction_y * height));
+        coord.x = enemy.NextUnknownInRow(coord.y, coord.x);
+        if (coord.x >= width) {
+            continue;
+        }
+        uint64_t score = ScoreCell(coord, game);
+        if (score > best_score) {
+            best = coord;
+            best_score = score;
+        }
     }
+    next_shot_coord_ = best;
 
     return next_shot_coord_;
 }
\ No newline at end of file
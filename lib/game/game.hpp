@@ -1,21 +1,38 @@
 #pragma once
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 #include <string>
+#include <thread>
+#include <variant>
 
+#include "cow.hpp"
 
-struct Coordinate {
-    int64_t x {0};
-    int64_t y {0};
 
-    Coordinate() = default;
-    Coordinate(int64_t x, int64_t y): x(x), y(y){}
-    bool operator==(const Coordinate& other) const {
+template <typename T>
+struct BasicCoordinate {
+    T x {0};
+    T y {0};
+
+    BasicCoordinate() = default;
+    BasicCoordinate(T x, T y): x(x), y(y){}
+    bool operator==(const BasicCoordinate& other) const {
         return x == other.x && y == other.y;
     }
+    // row-major order, flat copy-on-write chunks keep their entries sorted by it
+    bool operator<(const BasicCoordinate& other) const {
+        return y < other.y || (y == other.y && x < other.x);
+    }
 };
 
+// full-width coordinate used by the protocol and the strategies
+using Coordinate = BasicCoordinate<int64_t>;
+
 enum class ShotResult {
     kUndefined = -1,
     kMiss = 0,
@@ -43,30 +60,174 @@ enum class StrategyType {
 class Game;
 class Strategy;
 
-struct Ship {
-    std::vector<Coordinate> array;
+// a ship is its head, length and direction; alive decks are kept as a bit mask
+template <typename T>
+struct BasicShip {
+    constexpr static size_t kMaxSize {8};
+    BasicCoordinate<T> head {};
+    uint8_t size {0};
+    uint8_t alive_mask {0};
     bool is_horizontal {false};
-    Coordinate head {};
+
+    BasicShip() = default;
+    BasicShip(const BasicCoordinate<T>& head, size_t size, bool is_horizontal)
+        : head(head)
+        , size(size <= kMaxSize ? size : 0)
+        , alive_mask(size <= kMaxSize ? (1u << size) - 1 : 0)
+        , is_horizontal(is_horizontal){}
+    BasicCoordinate<T> GetCell(size_t i) const {
+        if (is_horizontal) {
+            return BasicCoordinate<T>(head.x + i, head.y);
+        }
+        return BasicCoordinate<T>(head.x, head.y + i);
+    }
 };
 
+using Ship = BasicShip<int64_t>;
+
 struct HashFunction {
-    size_t operator()(const Coordinate& coord) const {
-        return std::hash<int64_t>()(coord.x) ^ (std::hash<int64_t>()(coord.y) << 1);
+    template <typename T>
+    size_t operator()(const BasicCoordinate<T>& coord) const {
+        // hash_combine mix, a plain xor maps a whole board onto a few thousand values
+        size_t seed = std::hash<T>()(coord.x);
+
+        return seed ^ (std::hash<T>()(coord.y) + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2));
     }
 };
 
+// ship cells indexed by coordinate, T is the narrowest type that holds the field
+template <typename T>
+class Board {
+private:
+    // value of a cell whose deck is already destroyed
+    constexpr static uint32_t kDeadCell {std::numeric_limits<uint32_t>::max()};
+    CowVector<BasicShip<T>> ships_;
+    CowMap<BasicCoordinate<T>, uint32_t, HashFunction> cells_;
+
+    static bool Fits(const Coordinate& coord) {
+        return coord.x >= std::numeric_limits<T>::min() && coord.x <= std::numeric_limits<T>::max()
+            && coord.y >= std::numeric_limits<T>::min() && coord.y <= std::numeric_limits<T>::max();
+    }
+    static BasicCoordinate<T> Narrow(const Coordinate& coord) {
+        return BasicCoordinate<T>(static_cast<T>(coord.x), static_cast<T>(coord.y));
+    }
+public:
+    // largest absolute coordinate the board always holds
+    constexpr static uint64_t kMaxSide {static_cast<uint64_t>(std::numeric_limits<T>::max())};
+
+    bool CheckCoord(const Coordinate& coord) const {
+        return Fits(coord) && cells_.Contains(Narrow(coord));
+    }
+
+    bool CheckShip(const Coordinate& coord) const {
+        if (!Fits(coord)) {
+            return false;
+        }
+        const uint32_t* index = cells_.Find(Narrow(coord));
+
+        return index && *index != kDeadCell;
+    }
+
+    bool AddShip(const Ship& ship) {
+        if (ship.size == 0 || ship.size > Ship::kMaxSize) {
+            return false;
+        }
+        for (size_t i = 0; i < ship.size; ++i) {
+            if (!Fits(ship.GetCell(i))) {
+                return false;
+            }
+        }
+        BasicShip<T> narrow_ship(Narrow(ship.head), ship.size, ship.is_horizontal);
+        narrow_ship.alive_mask = ship.alive_mask;
+        uint32_t index = ships_.Size();
+        ships_.PushBack(narrow_ship);
+        for (size_t i = 0; i < ship.size; ++i) {
+            cells_[narrow_ship.GetCell(i)] = (ship.alive_mask >> i) & 1 ? index : kDeadCell;
+        }
+
+        return true;
+    }
+
+    ShotResult TakeShot(const Coordinate& coord) {
+        if (!Fits(coord)) {
+            return ShotResult::kMiss;
+        }
+        BasicCoordinate<T> cell = Narrow(coord);
+        const uint32_t* index = cells_.Find(cell);
+        if (!index || *index == kDeadCell) {
+            return ShotResult::kMiss;
+        }
+        BasicShip<T>& ship = ships_.Mutable(*index);
+        T deck = ship.is_horizontal ? coord.x - ship.head.x : coord.y - ship.head.y;
+        ship.alive_mask &= ~(1u << deck);
+        cells_[cell] = kDeadCell;
+
+        return ship.alive_mask ? ShotResult::kHit : ShotResult::kKill;
+    }
+
+    // ships in placement order, widened back to full coordinates
+    std::vector<Ship> GetShips() const {
+        std::vector<Ship> ships;
+        ships.reserve(ships_.Size());
+        for (size_t i = 0; i < ships_.Size(); ++i) {
+            const BasicShip<T>& narrow_ship = ships_[i];
+            Ship ship(Coordinate(narrow_ship.head.x, narrow_ship.head.y), narrow_ship.size, narrow_ship.is_horizontal);
+            ship.alive_mask = narrow_ship.alive_mask;
+            ships.push_back(ship);
+        }
+
+        return ships;
+    }
+
+    bool IsEmpty() const {
+        return ships_.IsEmpty();
+    }
+};
+
+// knowledge about the enemy board: fired cells, wounded ships and halos of sunk ones
+class EnemyField {
+private:
+    // known cells of each row, stored as merged closed intervals [first, second]
+    using Row = std::map<int64_t, int64_t>;
+    // rows are shared between forks too, a write copies only the touched row
+    CowMap<int64_t, std::shared_ptr<Row>> known_;
+    // cells of ships that were hit but not sunk yet
+    CowMap<Coordinate, bool, HashFunction> hits_;
+    uint64_t width_ {0};
+    uint64_t height_ {0};
+    constexpr static size_t kCntSize {4};
+    uint64_t sunk_cnt_[kCntSize] {0, 0, 0, 0};
+
+    void MarkHalo(const Coordinate&);
+public:
+    void Reset(uint64_t, uint64_t);
+    bool Contains(const Coordinate&) const;
+    bool IsKnown(const Coordinate&) const;
+    bool IsHit(const Coordinate&) const;
+    int64_t NextUnknownInRow(int64_t, int64_t) const;
+    void MarkKnown(const Coordinate&);
+    void MarkShot(const Coordinate&, const ShotResult&);
+    const CowMap<Coordinate, bool, HashFunction>& GetHits() const;
+    uint64_t GetSunkCount(size_t) const;
+};
+
 class Player {
 private:
     PlayerType type_{PlayerType::kSlave};
-    std::unordered_map<Coordinate, Ship*, HashFunction> ships_;
+    std::variant<Board<int16_t>, Board<int32_t>, Board<int64_t>> board_ {Board<int64_t>{}};
     ShotResult last_shot_result_ {ShotResult::kUndefined};
+
+    static uint64_t GetExtentUtil(const Ship&);
+    void ReshapeUtil(uint64_t);
 public:
     void SetMaster();
     bool CheckMaster();
-    bool CheckCoord(const Coordinate&, const Game&);
-    void AddShip(Ship*);
-    Ship* GetShip(const Coordinate&);
-    void DeleteCoord(const Coordinate&);
+    void Reshape(uint64_t, uint64_t);
+    bool CheckCoord(const Coordinate&) const;
+    bool CheckShip(const Coordinate&) const;
+    bool IsEmpty() const;
+    bool AddShip(const Ship&);
+    ShotResult TakeShot(const Coordinate&);
     void SetShotResult(const ShotResult&);
     const ShotResult& GetShotResult();
     void DumpShips(std::ofstream&);
@@ -85,22 +246,36 @@ class Strategy {
 protected:
     Coordinate next_shot_coord_ {};
     ShotResult last_shot_result {};
+    int64_t scan_row_ {0};
 public:
+    // zero-budget path: answers immediately
     virtual const Coordinate& ShotUtil(const Game&) = 0;
-    void PlaceOneSizeShips(size_t, int64_t, const Game&);
-    void PlaceShips(const Game&);
-    bool TryPlaceShip(Ship*, const Game&);
-    bool ValidateCell(const Coordinate&, const Game&);
+    // anytime path: refines the answer until the deadline, by default ignores the budget
+    virtual const Coordinate& ShotUtilUntil(const Game&, const std::chrono::steady_clock::time_point&);
+    // placement only touches the given player and field, so it may run on a worker thread
+    static void PlaceOneSizeShips(size_t, int64_t, const Field&, Player*, const std::atomic<bool>&);
+    static void PlaceShips(const Field&, Player*, const std::atomic<bool>&);
+    static bool TryPlaceShip(const Ship&, const Field&, Player*);
+    static bool ValidateCell(const Coordinate&, const Field&, const Player*);
+    bool FindUnknownCell(const Game&);
+    void Reset();
+
+    virtual Strategy* Clone() const = 0;
 
     virtual ~Strategy() = default;
 };
 
 class OrderedStrategy: public Strategy {
     const Coordinate& ShotUtil(const Game&) override;
+    Strategy* Clone() const override;
 };
 
 class CustomStrategy: public Strategy {
+    bool TryFinishShip(const Game&);
+    uint64_t ScoreCell(const Coordinate&, const Game&);
     const Coordinate& ShotUtil(const Game&) override;
+    const Coordinate& ShotUtilUntil(const Game&, const std::chrono::steady_clock::time_point&) override;
+    Strategy* Clone() const override;
 };
 
 class Game {
@@ -111,10 +286,24 @@ private:
     const uint64_t kTwoDeckDefaultValue {1};
     const uint64_t kThreeDeckDefaultValue {1};
     const uint64_t kFourDeckDefaultValue {1};
+    const uint64_t kMaxTimeLimitMs {24 * 60 * 60 * 1000};
+    const int64_t kDeadlineMarginShare {10};
 
     Field field_ {};
     Player* player_ {nullptr};
     Strategy* strategy_ {nullptr};
+    EnemyField enemy_field_ {};
+    Coordinate last_shot_ {};
+    uint64_t time_limit_ms_ {0};
+    uint64_t last_move_time_us_ {0};
+
+    // speculative placement, started once the configuration is complete
+    std::thread placement_thread_ {};
+    std::atomic<bool> placement_cancelled_ {false};
+    Player* placed_player_ {nullptr};
+    Field placed_field_ {};
+    // set while a batch of parameter changes runs, the batch schedules once at its end
+    bool is_placement_deferred_ {false};
     GameStatus current_game_status_ {GameStatus::kUndefined};
     GameStatus current_game_process_ {GameStatus::kUndefined};
 
@@ -122,6 +311,10 @@ private:
     const uint64_t& GetCountUtil(size_t) const;
     bool CheckCapacityUtil(size_t, uint64_t, int64_t, int64_t);
     void SetDefaultParametersUtil();
+    void CreateUtil(const PlayerType&);
+    bool CheckConfigUtil() const;
+    void SchedulePlacementUtil();
+    void CancelPlacementUtil();
 public:
     // control methods
     void PrintField() const;
@@ -133,23 +326,31 @@ public:
     bool SetHeight(uint64_t);
     bool SetWidth(uint64_t);
     bool SetCount(size_t, uint64_t);
+    bool SetTimeLimit(uint64_t);
     const uint64_t& GetHeight() const;
     const uint64_t& GetWidth() const;
     const uint64_t& GetCount(size_t) const;
+    const uint64_t& GetTimeLimit() const;
+    const uint64_t& GetMoveTime() const;
     void Load(const std::string&);
     void Dump(const std::string&);
+    // lightweight copy for what-if evaluation, boards and enemy knowledge are shared until written
+    std::unique_ptr<Game> Fork() const;
 
     // ingame methods
     void SetStrategy(const StrategyType&);
-    const Coordinate& SetShot();
+    bool SetShot(Coordinate*);
     std::string CheckShot(const Coordinate&);
     ShotResult SetShotResult(const std::string&);
+    void ApplyShotResult(const Coordinate&, const ShotResult&);
+    const EnemyField& GetEnemyField() const;
     bool IsFinished();
     bool IsWin();
     bool IsLose();
 
     Game() = default;
     ~Game() {
+        CancelPlacementUtil();
         delete player_;
         delete strategy_;
     }
@@ -104,6 +104,19 @@ signed Stream::WaitForQuery(Game& game) {
                 result = game.SetWidth(number);
             }
             result ? SendResponse("ok") : SendResponse("failed");
+        } else if (query.find("set timelimit") == 0) {
+            const size_t kTimeLimitPosition = 14;
+            bool result = false;
+            uint64_t number;
+            std::string str_number = query.size() > kTimeLimitPosition ? query.substr(kTimeLimitPosition) : "";
+            if (!str_number.starts_with('-') && TryParseNumber(str_number, &number)) {
+                result = game.SetTimeLimit(number);
+            }
+            result ? SendResponse("ok") : SendResponse("failed");
+        } else if (query == "get timelimit") {
+            SendResponse(game.GetTimeLimit());
+        } else if (query == "get movetime") {
+            SendResponse(game.GetMoveTime());
         } else if (query == "get height") {
             SendResponse(game.GetHeight());
         } else if (query == "get width") {
@@ -140,7 +153,8 @@ signed Stream::WaitForQuery(Game& game) {
                 SendErrorResponse();
             }
         } else if (query == "shot") {
-            SendResponse(game.SetShot());
+            Coordinate shot;
+            game.SetShot(&shot) ? SendResponse(shot) : SendResponse("failed");
         } else if (query == "set strategy ordered") {
             game.SetStrategy(StrategyType::kOrdered);
             SendResponse("ok");
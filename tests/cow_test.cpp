@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include "game/cow.hpp"
+
+
+TEST(CowMapTest, CopyIsIsolatedFromWrites) {
+    CowMap<int64_t, int64_t> map;
+    for (int64_t i = 0; i < 1000; ++i) {
+        map[i] = i;
+    }
+    CowMap<int64_t, int64_t> copy = map;
+    copy[5] = -5;
+    copy[1000] = 1000;
+    ASSERT_TRUE(copy.Erase(7));
+
+    EXPECT_EQ(*map.Find(5), 5);
+    EXPECT_FALSE(map.Contains(1000));
+    EXPECT_TRUE(map.Contains(7));
+    EXPECT_EQ(map.Size(), 1000);
+
+    EXPECT_EQ(*copy.Find(5), -5);
+    EXPECT_EQ(*copy.Find(1000), 1000);
+    EXPECT_FALSE(copy.Contains(7));
+    EXPECT_EQ(copy.Size(), 1000);
+}
+
+TEST(CowMapTest, OriginalWritesDoNotLeakIntoCopy) {
+    CowMap<int64_t, int64_t> map;
+    map[1] = 1;
+    CowMap<int64_t, int64_t> copy = map;
+    map[1] = 2;
+    for (int64_t i = 2; i < 5000; ++i) {
+        map[i] = i;
+    }
+
+    EXPECT_EQ(*copy.Find(1), 1);
+    EXPECT_EQ(copy.Size(), 1);
+    EXPECT_FALSE(copy.Contains(4999));
+    EXPECT_EQ(*map.Find(1), 2);
+    EXPECT_EQ(*map.Find(4999), 4999);
+}
+
+TEST(CowMapTest, AnyOfVisitsEveryEntry) {
+    CowMap<int64_t, int64_t> map;
+    for (int64_t i = 0; i < 300; ++i) {
+        map[i] = 1;
+    }
+    int64_t sum = 0;
+    EXPECT_FALSE(map.AnyOf([&sum](int64_t, int64_t value) {
+        sum += value;
+        return false;
+    }));
+    EXPECT_EQ(sum, 300);
+}
+
+TEST(CowVectorTest, CopyIsIsolatedFromWrites) {
+    CowVector<int64_t> vector;
+    for (int64_t i = 0; i < 10000; ++i) {
+        vector.PushBack(i);
+    }
+    CowVector<int64_t> copy = vector;
+    copy.Mutable(4242) = -1;
+    copy.PushBack(10000);
+    vector.Mutable(17) = -17;
+
+    EXPECT_EQ(vector[4242], 4242);
+    EXPECT_EQ(vector[17], -17);
+    EXPECT_EQ(vector.Size(), 10000);
+    EXPECT_EQ(copy[4242], -1);
+    EXPECT_EQ(copy[17], 17);
+    EXPECT_EQ(copy[10000], 10000);
+    EXPECT_EQ(copy.Size(), 10001);
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include "game/game.hpp"
+
+
+TEST(EnemyFieldTest, MarkKnownMergesFromBothSides) {
+    EnemyField enemy;
+    enemy.Reset(10, 10);
+    enemy.MarkKnown(Coordinate(2, 0));
+    enemy.MarkKnown(Coordinate(4, 0));
+    EXPECT_EQ(enemy.NextUnknownInRow(0, 2), 3);
+
+    enemy.MarkKnown(Coordinate(3, 0));
+    EXPECT_TRUE(enemy.IsKnown(Coordinate(3, 0)));
+    EXPECT_EQ(enemy.NextUnknownInRow(0, 2), 5);
+    EXPECT_EQ(enemy.NextUnknownInRow(0, 0), 0);
+    EXPECT_FALSE(enemy.IsKnown(Coordinate(1, 0)));
+    EXPECT_FALSE(enemy.IsKnown(Coordinate(5, 0)));
+}
+
+TEST(EnemyFieldTest, NextUnknownInRowSkipsMergedRun) {
+    EnemyField enemy;
+    enemy.Reset(10, 10);
+    for (int64_t x = 5; x >= 0; --x) {
+        enemy.MarkKnown(Coordinate(x, 3));
+    }
+    EXPECT_EQ(enemy.NextUnknownInRow(3, 0), 6);
+    EXPECT_EQ(enemy.NextUnknownInRow(3, 4), 6);
+    EXPECT_EQ(enemy.NextUnknownInRow(3, 7), 7);
+    EXPECT_EQ(enemy.NextUnknownInRow(2, 0), 0);
+}
+
+TEST(EnemyFieldTest, KillHaloStaysInsideCorner) {
+    EnemyField enemy;
+    enemy.Reset(10, 10);
+    enemy.MarkShot(Coordinate(0, 0), ShotResult::kKill);
+
+    EXPECT_TRUE(enemy.IsKnown(Coordinate(1, 0)));
+    EXPECT_TRUE(enemy.IsKnown(Coordinate(0, 1)));
+    EXPECT_TRUE(enemy.IsKnown(Coordinate(1, 1)));
+    EXPECT_FALSE(enemy.IsKnown(Coordinate(2, 0)));
+    EXPECT_FALSE(enemy.IsKnown(Coordinate(-1, 0)));
+    EXPECT_FALSE(enemy.IsKnown(Coordinate(0, -1)));
+    EXPECT_EQ(enemy.NextUnknownInRow(0, 0), 2);
+    EXPECT_EQ(enemy.NextUnknownInRow(1, 0), 2);
+    EXPECT_EQ(enemy.GetSunkCount(1), 1);
+}
+
+TEST(EnemyFieldTest, KillHaloStaysInsideEdge) {
+    EnemyField enemy;
+    enemy.Reset(10, 10);
+    enemy.MarkShot(Coordinate(9, 3), ShotResult::kHit);
+    enemy.MarkShot(Coordinate(9, 4), ShotResult::kKill);
+
+    EXPECT_FALSE(enemy.IsHit(Coordinate(9, 3)));
+    for (int64_t y = 2; y <= 5; ++y) {
+        EXPECT_TRUE(enemy.IsKnown(Coordinate(8, y)));
+        EXPECT_TRUE(enemy.IsKnown(Coordinate(9, y)));
+        EXPECT_FALSE(enemy.IsKnown(Coordinate(10, y)));
+    }
+    EXPECT_FALSE(enemy.IsKnown(Coordinate(9, 6)));
+    EXPECT_EQ(enemy.NextUnknownInRow(3, 0), 0);
+    EXPECT_EQ(enemy.NextUnknownInRow(3, 8), 10);
+}
+
+TEST(EnemyFieldTest, MultiDeckKillCountsOneShipOfItsSize) {
+    EnemyField enemy;
+    enemy.Reset(10, 10);
+    enemy.MarkShot(Coordinate(4, 5), ShotResult::kHit);
+    enemy.MarkShot(Coordinate(6, 5), ShotResult::kHit);
+    EXPECT_TRUE(enemy.IsHit(Coordinate(4, 5)));
+    EXPECT_TRUE(enemy.IsKnown(Coordinate(3, 4)));
+    EXPECT_FALSE(enemy.IsKnown(Coordinate(5, 5)));
+
+    enemy.MarkShot(Coordinate(5, 5), ShotResult::kKill);
+    EXPECT_EQ(enemy.GetSunkCount(3), 1);
+    EXPECT_EQ(enemy.GetSunkCount(1), 0);
+    EXPECT_EQ(enemy.GetSunkCount(2), 0);
+    EXPECT_FALSE(enemy.IsHit(Coordinate(4, 5)));
+    EXPECT_FALSE(enemy.IsHit(Coordinate(6, 5)));
+    EXPECT_TRUE(enemy.IsKnown(Coordinate(3, 5)));
+    EXPECT_TRUE(enemy.IsKnown(Coordinate(7, 6)));
+    EXPECT_FALSE(enemy.IsKnown(Coordinate(8, 5)));
+}
+
+TEST(EnemyFieldTest, ShotFailsOnceEveryCellIsKnown) {
+    Game game;
+    game.Create(PlayerType::kMaster);
+    game.SetStrategy(StrategyType::kOrdered);
+    game.Start();
+
+    for (int64_t i = 0; i < 100; ++i) {
+        Coordinate shot;
+        ASSERT_TRUE(game.SetShot(&shot));
+        EXPECT_EQ(shot, Coordinate(i % 10, i / 10));
+        game.SetShotResult("miss");
+    }
+    Coordinate shot;
+    EXPECT_FALSE(game.SetShot(&shot));
+}
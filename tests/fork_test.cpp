@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include "game/game.hpp"
+
+
+namespace {
+
+void StartGame(Game& game) {
+    game.Create(PlayerType::kSlave);
+    game.SetWidth(10);
+    game.SetHeight(10);
+    game.SetCount(4, 1);
+    game.Start();
+}
+
+} // namespace
+
+TEST(ForkTest, ShotsAtForkDoNotTouchOriginalBoard) {
+    Game game;
+    StartGame(game);
+    std::unique_ptr<Game> fork = game.Fork();
+
+    ASSERT_EQ(fork->CheckShot(Coordinate(0, 0)), "hit");
+    EXPECT_EQ(fork->CheckShot(Coordinate(0, 0)), "miss");
+    EXPECT_EQ(game.CheckShot(Coordinate(0, 0)), "hit");
+
+    std::unique_ptr<Game> second_fork = game.Fork();
+    EXPECT_EQ(second_fork->CheckShot(Coordinate(0, 0)), "miss");
+    EXPECT_EQ(second_fork->CheckShot(Coordinate(1, 0)), "hit");
+    EXPECT_EQ(game.CheckShot(Coordinate(1, 0)), "hit");
+}
+
+TEST(ForkTest, HypotheticalResultsStayInFork) {
+    Game game;
+    StartGame(game);
+    std::unique_ptr<Game> fork = game.Fork();
+
+    fork->ApplyShotResult(Coordinate(5, 5), ShotResult::kHit);
+    EXPECT_TRUE(fork->GetEnemyField().IsHit(Coordinate(5, 5)));
+    EXPECT_TRUE(fork->GetEnemyField().IsKnown(Coordinate(4, 4)));
+    EXPECT_FALSE(game.GetEnemyField().IsKnown(Coordinate(5, 5)));
+
+    fork->ApplyShotResult(Coordinate(5, 6), ShotResult::kKill);
+    EXPECT_FALSE(fork->GetEnemyField().IsHit(Coordinate(5, 5)));
+    EXPECT_TRUE(fork->GetEnemyField().IsKnown(Coordinate(5, 7)));
+    EXPECT_EQ(fork->GetEnemyField().GetSunkCount(2), 1);
+    EXPECT_EQ(game.GetEnemyField().GetSunkCount(2), 0);
+
+    Coordinate original_shot;
+    ASSERT_TRUE(game.SetShot(&original_shot));
+    EXPECT_EQ(original_shot, Coordinate(0, 0));
+}
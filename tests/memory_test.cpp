@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+#include "game/game.hpp"
+
+#ifdef __GLIBC__
+#include <malloc.h>
+
+
+namespace {
+
+// heap bytes the player holds per ship cell
+double BytesPerCell(const Field& field, uint64_t cell_cnt) {
+    size_t before = mallinfo2().uordblks;
+    Player* player = new Player;
+    player->Reshape(field.width, field.height);
+    const std::atomic<bool> kNotCancelled {false};
+    Strategy::PlaceShips(field, player, kNotCancelled);
+    size_t after = mallinfo2().uordblks;
+    delete player;
+
+    return static_cast<double>(after - before) / cell_cnt;
+}
+
+} // namespace
+
+TEST(MemoryTest, ClassicFleetFitsBudget) {
+    Field field;
+    field.width = 10;
+    field.height = 10;
+    field.ships_cnt_[0] = 4;
+    field.ships_cnt_[1] = 3;
+    field.ships_cnt_[2] = 2;
+    field.ships_cnt_[3] = 1;
+
+    EXPECT_LE(BytesPerCell(field, 20), 69);
+}
+
+TEST(MemoryTest, LargeBoardFitsBudget) {
+    Field field;
+    field.width = 1000;
+    field.height = 1000;
+    field.ships_cnt_[3] = 20000;
+
+    EXPECT_LE(BytesPerCell(field, 80000), 35);
+}
+
+#endif
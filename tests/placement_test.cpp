@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "game/game.hpp"
+
+
+namespace {
+
+std::string ReadFile(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+
+    return content.str();
+}
+
+std::string SynchronousDump(const Field& field, const std::filesystem::path& path) {
+    Player player;
+    player.Reshape(field.width, field.height);
+    const std::atomic<bool> kNotCancelled {false};
+    Strategy::PlaceShips(field, &player, kNotCancelled);
+    {
+        std::ofstream file(path);
+        file << field.width << " " << field.height << '\n';
+        player.DumpShips(file);
+    }
+
+    return ReadFile(path);
+}
+
+void ExpectPreplacedMatchesSynchronous(uint64_t width, uint64_t height, const uint64_t (&counts)[4]) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "placement_test_dump.txt";
+    Game game;
+    game.Create(PlayerType::kSlave);
+    game.SetWidth(width);
+    game.SetHeight(height);
+    Field field;
+    field.width = width;
+    field.height = height;
+    for (size_t n = 1; n <= 4; ++n) {
+        ASSERT_TRUE(game.SetCount(n, counts[n - 1]));
+        field.ships_cnt_[n - 1] = counts[n - 1];
+    }
+    game.Start();
+    game.Dump(path.string());
+    std::string preplaced = ReadFile(path);
+
+    EXPECT_EQ(preplaced, SynchronousDump(field, path));
+    std::filesystem::remove(path);
+}
+
+} // namespace
+
+TEST(PlacementTest, PreplacedPlayerMatchesSynchronousPlacement) {
+    ExpectPreplacedMatchesSynchronous(10, 10, {1, 1, 1, 1});
+    ExpectPreplacedMatchesSynchronous(30, 30, {4, 3, 2, 1});
+    ExpectPreplacedMatchesSynchronous(100, 50, {20, 15, 10, 5});
+}
+
+TEST(PlacementTest, MasterDefaultsArePreplaced) {
+    Game game;
+    game.Create(PlayerType::kMaster);
+    game.Start();
+    EXPECT_EQ(game.CheckShot(Coordinate(0, 0)), "hit");
+}
+
+TEST(PlacementTest, LoadedShipsBeyondFieldAreKept) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "placement_test_load.txt";
+    const std::string kDump = "10 10\n2 h 40000 3\n1 v 0 0\n3 v 5 3000000000 101\n";
+    {
+        std::ofstream file(path);
+        file << kDump;
+    }
+    Game game;
+    game.Load(path.string());
+    game.Dump(path.string());
+
+    EXPECT_EQ(ReadFile(path), kDump);
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+
+#include "game/game.hpp"
+
+
+TEST(ShotTest, TimedShotIsUnknownAndWithinBudget) {
+    const uint64_t kSide {2000};
+    const uint64_t kLimitMs {5};
+    Game game;
+    game.Create(PlayerType::kSlave);
+    game.SetWidth(kSide);
+    game.SetHeight(kSide);
+    game.SetCount(1, 1);
+    game.SetStrategy(StrategyType::kCustom);
+    ASSERT_TRUE(game.SetTimeLimit(kLimitMs));
+    game.Start();
+    game.ApplyShotResult(Coordinate(0, 0), ShotResult::kMiss);
+    game.ApplyShotResult(Coordinate(1, 0), ShotResult::kMiss);
+
+    for (size_t i = 0; i < 5; ++i) {
+        Coordinate shot;
+        ASSERT_TRUE(game.SetShot(&shot));
+        EXPECT_TRUE(game.GetEnemyField().Contains(shot));
+        EXPECT_FALSE(game.GetEnemyField().IsKnown(shot));
+        EXPECT_LE(game.GetMoveTime(), kLimitMs * 1000);
+        game.SetShotResult("miss");
+    }
+}
@@ -0,0 +1,429 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <cerrno>
+#include <csignal>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "loadgen.hpp"
+
+
+namespace {
+
+std::string EscapeJson(const std::string& str) {
+    std::ostringstream escaped;
+    for (char symbol: str) {
+        if (symbol == '"' || symbol == '\\') {
+            escaped << '\\' << symbol;
+        } else if (static_cast<unsigned char>(symbol) < 0x20) {
+            escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                    << static_cast<int>(symbol) << std::dec;
+        } else {
+            escaped << symbol;
+        }
+    }
+
+    return escaped.str();
+}
+
+// pipe2 is Linux-only, so close-on-exec is set after pipe; the lock keeps
+// parallel jobs from forking between the two calls
+std::mutex launch_mutex;
+
+bool MakePipe(int fds[2]) {
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    if (fcntl(fds[0], F_SETFD, FD_CLOEXEC) != 0 || fcntl(fds[1], F_SETFD, FD_CLOEXEC) != 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+// class BotProcess methods
+bool BotProcess::Launch(const std::string& path) {
+    int to_bot[2];
+    int from_bot[2];
+    // close-on-exec keeps other bots spawned by parallel jobs from holding these pipes open
+    std::lock_guard<std::mutex> lock(launch_mutex);
+    if (!MakePipe(to_bot)) {
+        return false;
+    }
+    if (!MakePipe(from_bot)) {
+        close(to_bot[0]);
+        close(to_bot[1]);
+        return false;
+    }
+
+    pid_ = fork();
+    if (pid_ < 0) {
+        close(to_bot[0]);
+        close(to_bot[1]);
+        close(from_bot[0]);
+        close(from_bot[1]);
+        return false;
+    }
+    if (pid_ == 0) {
+        dup2(to_bot[0], STDIN_FILENO);
+        dup2(from_bot[1], STDOUT_FILENO);
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDERR_FILENO);
+            close(null_fd);
+        }
+        close(to_bot[0]);
+        close(to_bot[1]);
+        close(from_bot[0]);
+        close(from_bot[1]);
+        execl(path.c_str(), path.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+
+    close(to_bot[0]);
+    close(from_bot[1]);
+    input_ = fdopen(to_bot[1], "w");
+    output_fd_ = from_bot[0];
+
+    return input_ != nullptr;
+}
+
+// waits for a whole line at most timeout_ms_, a bot that misses it is killed
+bool BotProcess::ReadLineUtil(std::string* line) {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now()
+                                                    + std::chrono::milliseconds(timeout_ms_);
+    size_t line_end;
+    while ((line_end = buffer_.find('\n')) == std::string::npos) {
+        int wait_ms = -1;
+        if (timeout_ms_ > 0) {
+            std::chrono::steady_clock::duration left = deadline - std::chrono::steady_clock::now();
+            wait_ms = static_cast<int>(std::max<int64_t>(0, std::chrono::ceil<std::chrono::milliseconds>(left).count()));
+        }
+        pollfd output = {output_fd_, POLLIN, 0};
+        int ready = poll(&output, 1, wait_ms);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready == 0) {
+            kill(pid_, SIGKILL);
+            return false;
+        }
+        char chunk[4096];
+        ssize_t read_cnt = ready < 0 ? -1 : read(output_fd_, chunk, sizeof(chunk));
+        if (read_cnt <= 0) {
+            return false;
+        }
+        buffer_.append(chunk, read_cnt);
+    }
+    line->assign(buffer_, 0, line_end);
+    buffer_.erase(0, line_end + 1);
+
+    return true;
+}
+
+bool BotProcess::Query(const std::string& command, std::string* response) {
+    if (!input_ || output_fd_ < 0) {
+        return false;
+    }
+    if (std::fputs(command.c_str(), input_) < 0 || std::fputc('\n', input_) < 0 || std::fflush(input_) != 0) {
+        return false;
+    }
+
+    return ReadLineUtil(response);
+}
+
+void BotProcess::Close() {
+    if (input_) {
+        std::fputs("exit\n", input_);
+        std::fclose(input_);
+        input_ = nullptr;
+    }
+    if (output_fd_ >= 0) {
+        close(output_fd_);
+        output_fd_ = -1;
+    }
+    buffer_.clear();
+    if (pid_ > 0) {
+        waitpid(pid_, nullptr, 0);
+        pid_ = -1;
+    }
+}
+
+// class Referee methods
+bool Referee::LoadFleet(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    uint64_t width;
+    uint64_t height;
+    file >> width >> height;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream ship_line(line);
+        size_t ship_size;
+        char direction;
+        int64_t x_coord;
+        int64_t y_coord;
+        if (!(ship_line >> ship_size >> direction >> x_coord >> y_coord)) {
+            continue;
+        }
+        // wounded ships carry the state of every deck, 1 for alive
+        std::string decks;
+        ship_line >> decks;
+        size_t index = decks_alive_.size();
+        decks_alive_.push_back(0);
+        for (int64_t i = 0; i < ship_size; ++i) {
+            if (decks.size() == ship_size && decks[i] != '1') {
+                continue;
+            }
+            ++decks_alive_[index];
+            if (direction == 'h') {
+                cells_[Coordinate(x_coord + i, y_coord)] = index;
+            } else {
+                cells_[Coordinate(x_coord, y_coord + i)] = index;
+            }
+        }
+        ships_alive_ += decks_alive_[index] > 0;
+    }
+
+    return ships_alive_ > 0;
+}
+
+std::string Referee::Shoot(const Coordinate& coord) {
+    auto iterator = cells_.find(coord);
+    if (iterator == cells_.end()) {
+        return "miss";
+    }
+    size_t index = iterator->second;
+    cells_.erase(iterator);
+    if (--decks_alive_[index] > 0) {
+        return "hit";
+    }
+    --ships_alive_;
+
+    return "kill";
+}
+
+bool Referee::AllSunk() const {
+    return ships_alive_ == 0;
+}
+
+// class LatencyStats methods
+void LatencyStats::Add(const std::string& command, double latency_us) {
+    samples_[command].push_back(latency_us);
+}
+
+void LatencyStats::Merge(const LatencyStats& other) {
+    for (const auto& [command, samples]: other.samples_) {
+        std::vector<double>& dest = samples_[command];
+        dest.insert(dest.end(), samples.begin(), samples.end());
+    }
+}
+
+uint64_t LatencyStats::GetCount() const {
+    uint64_t count = 0;
+    for (const auto& [command, samples]: samples_) {
+        count += samples.size();
+    }
+
+    return count;
+}
+
+void LatencyStats::WriteJson(std::ostream& stream) const {
+    stream << "{";
+    bool first = true;
+    for (const auto& [command, samples]: samples_) {
+        std::vector<double> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0;
+        for (double sample: sorted) {
+            sum += sample;
+        }
+        auto percentile = [&sorted](double rank) {
+            size_t index = static_cast<size_t>(rank * (sorted.size() - 1) + 0.5);
+            return sorted[index];
+        };
+        stream << (first ? "\n" : ",\n");
+        stream << "    \"" << command << "\": {"
+               << "\"count\": " << sorted.size()
+               << ", \"mean\": " << sum / sorted.size()
+               << ", \"p50\": " << percentile(0.5)
+               << ", \"p90\": " << percentile(0.9)
+               << ", \"p99\": " << percentile(0.99)
+               << ", \"max\": " << sorted.back()
+               << "}";
+        first = false;
+    }
+    stream << (first ? "}" : "\n  }");
+}
+
+// class LoadGenerator methods
+bool LoadGenerator::TimedQuery(BotProcess& bot, LatencyStats& stats, const std::string& name
+                                , const std::string& command, std::string* response) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool result = bot.Query(command, response);
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    if (result) {
+        stats.Add(name, elapsed.count());
+    }
+
+    return result;
+}
+
+bool LoadGenerator::PlayMatch(uint64_t match, LatencyStats& stats) {
+    std::filesystem::path dump_path = std::filesystem::temp_directory_path()
+                                    / ("loadgen_" + std::to_string(getpid()) + "_" + std::to_string(match) + ".txt");
+    BotProcess bot(config_.query_timeout_ms);
+    if (!bot.Launch(config_.bot_path)) {
+        return false;
+    }
+    std::string response;
+    auto query = [&](const std::string& name, const std::string& command) {
+        return TimedQuery(bot, stats, name, command, &response);
+    };
+
+    bool is_configured = query("ping", "ping")
+                        && query("create", "create " + config_.role)
+                        && query("set width", "set width " + std::to_string(config_.width))
+                        && query("set height", "set height " + std::to_string(config_.height));
+    for (size_t n = LoadConfig::kCntSize; n >= 1 && is_configured; --n) {
+        is_configured = query("set count", "set count " + std::to_string(n)
+                                            + " " + std::to_string(config_.ships_cnt_[n - 1]))
+                        && response == "ok";
+    }
+    if (is_configured && config_.role == "master") {
+        is_configured = query("get width", "get width") && query("get height", "get height");
+        for (size_t n = 1; n <= LoadConfig::kCntSize && is_configured; ++n) {
+            is_configured = query("get count", "get count " + std::to_string(n));
+        }
+    }
+    if (is_configured && config_.time_limit_ms > 0) {
+        is_configured = query("set timelimit", "set timelimit " + std::to_string(config_.time_limit_ms));
+    }
+    is_configured = is_configured
+                    && query("start", "start")
+                    && query("dump", "dump " + dump_path.string());
+
+    // the bot plays against its own placement, which is deterministic for a configuration
+    Referee referee;
+    if (!is_configured || !referee.LoadFleet(dump_path.string())) {
+        std::filesystem::remove(dump_path);
+        return false;
+    }
+
+    uint64_t ships_total = 0;
+    for (size_t i = 0; i < LoadConfig::kCntSize; ++i) {
+        ships_total += config_.ships_cnt_[i];
+    }
+    uint64_t our_kills = 0;
+    Coordinate our_shot(0, 0);
+    const uint64_t kMaxTurns = 2 * (config_.width * config_.height + 1);
+    bool is_finished = false;
+    // the slave shoots first, so against a master bot the generator opens the match
+    bool is_bot_turn = (config_.role == "slave");
+    for (uint64_t turn = 0; turn < kMaxTurns; ++turn, is_bot_turn = !is_bot_turn) {
+        if (is_bot_turn) {
+            if (!query("shot", "shot")) {
+                break;
+            }
+            std::istringstream coordinates(response);
+            Coordinate bot_shot;
+            if (!(coordinates >> bot_shot.x >> bot_shot.y)) {
+                break;
+            }
+            if (!query("set result", "set result " + referee.Shoot(bot_shot))) {
+                break;
+            }
+            if (referee.AllSunk()) {
+                is_finished = query("win", "win") && response == "yes";
+                break;
+            }
+        } else {
+            if (!query("shot X Y", "shot " + std::to_string(our_shot.x) + " " + std::to_string(our_shot.y))) {
+                break;
+            }
+            if (response == "kill" && ++our_kills == ships_total) {
+                is_finished = query("lose", "lose") && response == "yes";
+                break;
+            }
+            if (++our_shot.x >= config_.width) {
+                our_shot.x = 0;
+                ++our_shot.y;
+            }
+        }
+    }
+    is_finished = is_finished && query("load", "load " + dump_path.string());
+    bot.Close();
+    std::filesystem::remove(dump_path);
+
+    return is_finished;
+}
+
+void LoadGenerator::Run() {
+    std::atomic<uint64_t> next_match {0};
+    std::atomic<uint64_t> failed_matches {0};
+    std::mutex stats_mutex;
+    std::vector<std::thread> workers;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint64_t job = 0; job < config_.jobs; ++job) {
+        workers.emplace_back([&]() {
+            LatencyStats local_stats;
+            for (uint64_t match = next_match++; match < config_.matches; match = next_match++) {
+                if (!PlayMatch(match, local_stats)) {
+                    ++failed_matches;
+                }
+            }
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            stats_.Merge(local_stats);
+        });
+    }
+    for (std::thread& worker: workers) {
+        worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    wall_seconds_ = elapsed.count();
+    failed_matches_ = failed_matches;
+}
+
+void LoadGenerator::WriteReport(std::ostream& stream) const {
+    uint64_t commands = stats_.GetCount();
+    stream << std::fixed << std::setprecision(3);
+    stream << "{\n"
+           << "  \"bot\": \"" << EscapeJson(config_.bot_path) << "\",\n"
+           << "  \"role\": \"" << config_.role << "\",\n"
+           << "  \"width\": " << config_.width << ",\n"
+           << "  \"height\": " << config_.height << ",\n"
+           << "  \"counts\": [" << config_.ships_cnt_[0] << ", " << config_.ships_cnt_[1] << ", "
+                                << config_.ships_cnt_[2] << ", " << config_.ships_cnt_[3] << "],\n"
+           << "  \"timelimit_ms\": " << config_.time_limit_ms << ",\n"
+           << "  \"jobs\": " << config_.jobs << ",\n"
+           << "  \"matches\": " << config_.matches << ",\n"
+           << "  \"timeout_ms\": " << config_.query_timeout_ms << ",\n"
+           << "  \"failed_matches\": " << failed_matches_ << ",\n"
+           << "  \"wall_seconds\": " << wall_seconds_ << ",\n"
+           << "  \"commands\": " << commands << ",\n"
+           << "  \"commands_per_second\": " << (wall_seconds_ > 0 ? commands / wall_seconds_ : 0) << ",\n"
+           << "  \"matches_per_second\": " << (wall_seconds_ > 0 ? config_.matches / wall_seconds_ : 0) << ",\n"
+           << "  \"latency_us\": ";
+    stats_.WriteJson(stream);
+    stream << "\n}\n";
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "game/game.hpp"
+
+
+struct LoadConfig {
+    constexpr static size_t kCntSize {4};
+    std::string bot_path {};
+    std::string role {"slave"};
+    uint64_t width {10};
+    uint64_t height {10};
+    uint64_t ships_cnt_[kCntSize] {1, 1, 1, 1};
+    uint64_t time_limit_ms {0};
+    uint64_t jobs {1};
+    uint64_t matches {1};
+    uint64_t query_timeout_ms {10000};
+};
+
+// bot executable driven through its stdin/stdout
+class BotProcess {
+private:
+    pid_t pid_ {-1};
+    FILE* input_ {nullptr};
+    int output_fd_ {-1};
+    std::string buffer_ {};
+    // 0 waits for an answer forever
+    uint64_t timeout_ms_ {0};
+
+    bool ReadLineUtil(std::string*);
+public:
+    bool Launch(const std::string&);
+    bool Query(const std::string&, std::string*);
+    void Close();
+
+    BotProcess() = default;
+    explicit BotProcess(uint64_t timeout_ms): timeout_ms_(timeout_ms){}
+    ~BotProcess() {
+        Close();
+    }
+    BotProcess& operator=(const BotProcess& other) = delete;
+    BotProcess(const BotProcess& other) = delete;
+};
+
+// answers the bot's shots against a fleet read from a dump file
+class Referee {
+private:
+    std::unordered_map<Coordinate, size_t, HashFunction> cells_;
+    std::vector<uint64_t> decks_alive_;
+    uint64_t ships_alive_ {0};
+public:
+    bool LoadFleet(const std::string&);
+    std::string Shoot(const Coordinate&);
+    bool AllSunk() const;
+};
+
+// round-trip latencies in microseconds, grouped by command
+class LatencyStats {
+private:
+    std::map<std::string, std::vector<double>> samples_;
+public:
+    void Add(const std::string&, double);
+    void Merge(const LatencyStats&);
+    uint64_t GetCount() const;
+    void WriteJson(std::ostream&) const;
+};
+
+class LoadGenerator {
+private:
+    LoadConfig config_ {};
+    LatencyStats stats_ {};
+    uint64_t failed_matches_ {0};
+    double wall_seconds_ {0};
+
+    bool TimedQuery(BotProcess&, LatencyStats&, const std::string&, const std::string&, std::string*);
+    bool PlayMatch(uint64_t, LatencyStats&);
+public:
+    explicit LoadGenerator(const LoadConfig& config): config_(config){}
+    void Run();
+    void WriteReport(std::ostream&) const;
+};
@@ -0,0 +1,84 @@
+#include <charconv>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "loadgen.hpp"
+
+
+namespace {
+
+void PrintUsage() {
+    std::cerr << "Usage: loadgen [--bin PATH] [--role slave|master] [--width N] [--height N]\n"
+              << "               [--count1 N] [--count2 N] [--count3 N] [--count4 N]\n"
+              << "               [--timelimit MS] [--timeout MS] [--jobs N] [--matches N] [--out PATH]\n";
+}
+
+bool TryParseNumber(const std::string& number, uint64_t* dest) {
+    std::from_chars_result parse_result = std::from_chars(number.data(), number.data() + number.size(), *dest);
+
+    return parse_result.ec == std::errc() && parse_result.ptr == number.data() + number.size();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    LoadConfig config;
+    config.bot_path = LOADGEN_DEFAULT_BOT;
+    std::string out_path;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (i + 1 >= argc) {
+            PrintUsage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        bool is_valid = true;
+        if (option == "--bin") {
+            config.bot_path = value;
+        } else if (option == "--role") {
+            config.role = value;
+            is_valid = (value == "slave" || value == "master");
+        } else if (option == "--out") {
+            out_path = value;
+        } else if (option == "--width") {
+            is_valid = TryParseNumber(value, &config.width);
+        } else if (option == "--height") {
+            is_valid = TryParseNumber(value, &config.height);
+        } else if (option.find("--count") == 0 && option.size() == 8
+                    && option[7] >= '1' && option[7] <= '4') {
+            is_valid = TryParseNumber(value, &config.ships_cnt_[option[7] - '1']);
+        } else if (option == "--timelimit") {
+            is_valid = TryParseNumber(value, &config.time_limit_ms);
+        } else if (option == "--timeout") {
+            // poll takes the wait as an int
+            is_valid = TryParseNumber(value, &config.query_timeout_ms) && config.query_timeout_ms <= INT32_MAX;
+        } else if (option == "--jobs") {
+            is_valid = TryParseNumber(value, &config.jobs) && config.jobs > 0;
+        } else if (option == "--matches") {
+            is_valid = TryParseNumber(value, &config.matches);
+        } else {
+            is_valid = false;
+        }
+        if (!is_valid) {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    // a bot dying mid-match must fail the match, not the generator
+    std::signal(SIGPIPE, SIG_IGN);
+
+    LoadGenerator generator(config);
+    generator.Run();
+    if (out_path.empty()) {
+        generator.WriteReport(std::cout);
+    } else {
+        std::ofstream file(out_path);
+        generator.WriteReport(file);
+    }
+
+    return 0;
+}